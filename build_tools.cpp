@@ -0,0 +1,50 @@
+#include "build_tools.hpp"
+
+namespace compilation_database
+{
+
+   namespace build_tools
+   {
+
+      const registered_profile *
+      registry::find (const std::string & name) const
+      {
+         auto i = profiles_.find (name);
+         if (i == std::end (profiles_))
+         {
+            return nullptr;
+         }
+
+         return &i->second;
+      }
+
+      std::vector<std::string>
+      registry::names () const
+      {
+         std::vector<std::string> n;
+         for (const auto & p : profiles_)
+         {
+            n.push_back (p.first);
+         }
+
+         return n;
+      }
+
+      const registry &
+      default_registry ()
+      {
+         static const registry r = []
+         {
+            registry r;
+            r.add<make> ();
+            r.add<boost_build> ();
+            r.add<ninja> ();
+            return r;
+         } ();
+
+         return r;
+      }
+
+   }
+
+}
@@ -0,0 +1,449 @@
+#ifndef build_tools_hpp_
+#define build_tools_hpp_
+
+#include <iostream>
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <boost/algorithm/string.hpp>
+#include <boost/utility/string_ref.hpp>
+
+#include <map>
+#include <vector>
+#include <string>
+
+#include <regex>
+
+#include "compilation_database.hpp"
+#include "languages.hpp"
+
+namespace compilation_database
+{
+
+   // A build tool profile is a type with
+   //
+   //    static const char * name ();
+   //    static const std::vector<boost::filesystem::path> & compilers ();
+   //    static std::vector<boost::filesystem::path> extensions ();
+   //
+   //    // true if the compiler of a command is one of the compilers
+   //    bool matches_compiler (const std::string & compiler,
+   //                           const boost::filesystem::path & c) const;
+   //
+   //    // sets the command, compiler, and filename if the line is a
+   //    // compile command, the command refers to the line
+   //    bool match (const std::string & line,
+   //                boost::string_ref & command,
+   //                std::string & compiler,
+   //                std::string & filename) const;
+   //
+   //    // updates the stack of directories if the line is printed by
+   //    // the build tool when it changes directory
+   //    bool track_directory (const std::string & line,
+   //                          std::vector<boost::filesystem::path> & directories) const;
+   //
+   // parse is instantiated for each profile so that there is no
+   // dispatch on the build tool for each line.
+   namespace build_tools
+   {
+
+      struct parse_options
+      {
+         boost::filesystem::path root_directory;
+         std::vector<boost::filesystem::path> compilers;
+         std::vector<boost::filesystem::path> extensions;
+      };
+
+      namespace detail
+      {
+
+         inline bool
+         match (const std::regex & r,
+                boost::string_ref command,
+                std::string & compiler,
+                std::string & filename)
+         {
+            std::cmatch m;
+            if (!std::regex_match (command.begin (),command.end (),m,r) ||
+                (m.size () != 3))
+            {
+               return false;
+            }
+
+            compiler = m.str (1);
+            filename = m.str (2);
+            return true;
+         }
+
+         // the directory given by a line such as "make: Entering
+         // directory '/path'", where the quotes may be `' or '' and
+         // the name of the tool is compared without an extension
+         inline bool
+         entering_directory (const std::string & line,
+                             const std::vector<std::string> & tools,
+                             bool & entering,
+                             boost::filesystem::path & directory)
+         {
+            // avoid the regex for the lines that are commands
+            if (line.find (" directory ") == std::string::npos)
+            {
+               return false;
+            }
+
+            static const std::regex r ("^([^ :[]+)(\\[[0-9]+\\])?: (Entering|Leaving) directory [`']([^']*)'$");
+
+            std::smatch m;
+            if (!std::regex_match (line,m,r))
+            {
+               return false;
+            }
+
+            const auto tool = boost::filesystem::path (m.str (1)).stem ().string ();
+            if (std::find (std::begin (tools),std::end (tools),tool) == std::end (tools))
+            {
+               return false;
+            }
+
+            entering = m.str (3) == "Entering";
+            directory = m.str (4);
+            return true;
+         }
+
+         inline boost::filesystem::path
+         join (const boost::filesystem::path & directory,
+               const boost::filesystem::path & d)
+         {
+            return d.is_absolute () ? d : directory / d;
+         }
+
+      }
+
+      // the compilers and filename extensions used by a profile
+      struct default_languages
+      {
+         static const std::vector<boost::filesystem::path> &
+         compilers ()
+         {
+            return compilation_database::default_compilers ();
+         }
+
+         static std::vector<boost::filesystem::path>
+         extensions ()
+         {
+            return compilation_database::default_extensions ();
+         }
+
+         // the compiler is compared as it is written in the command
+         bool
+         matches_compiler (const std::string & compiler,
+                           const boost::filesystem::path & c) const
+         {
+            return c.native () == compiler;
+         }
+      };
+
+      // GNU make, including the directories printed by -w and
+      // recursive make, which is also run as gmake and mingw32-make
+      struct make : default_languages
+      {
+         static const char *
+         name ()
+         {
+            return "make";
+         }
+
+         bool
+         match (const std::string & line,
+                boost::string_ref & command,
+                std::string & compiler,
+                std::string & filename) const
+         {
+            static const std::regex r ("^([^ ]+) .* ([^ ]+) +-o [^ ]+ *$");
+
+            command = line;
+            return detail::match (r,command,compiler,filename);
+         }
+
+         bool
+         track_directory (const std::string & line,
+                          std::vector<boost::filesystem::path> & directories) const
+         {
+            static const std::vector<std::string> tools = { "make", "gmake", "mingw32-make" };
+
+            bool entering;
+            boost::filesystem::path directory;
+            if (!detail::entering_directory (line,tools,entering,directory))
+            {
+               return false;
+            }
+
+            if (entering)
+            {
+               directories.push_back (detail::join (directories.back (),directory));
+            }
+            else if (directories.size () > 1)
+            {
+               directories.pop_back ();
+            }
+            return true;
+         }
+      };
+
+      struct boost_build : default_languages
+      {
+         static const char *
+         name ()
+         {
+            return "Boost.Build";
+         }
+
+         bool
+         match (const std::string & line,
+                boost::string_ref & command,
+                std::string & compiler,
+                std::string & filename) const
+         {
+            static const std::regex r ("^\"([^\"]+)\" .+ \"([^\"]+)\"$");
+
+            command = line;
+            return detail::match (r,command,compiler,filename);
+         }
+
+         bool
+         track_directory (const std::string &,
+                          std::vector<boost::filesystem::path> &) const
+         {
+            return false;
+         }
+      };
+
+      // ninja -v, which prefixes each command with "[n/m] "
+      struct ninja : default_languages
+      {
+         static const char *
+         name ()
+         {
+            return "ninja";
+         }
+
+         // CMake writes the absolute filename of the compiler, so a
+         // compiler given without a directory is compared with the
+         // filename of the compiler of the command
+         bool
+         matches_compiler (const std::string & compiler,
+                           const boost::filesystem::path & c) const
+         {
+            if (c.has_parent_path ())
+            {
+               return c.native () == compiler;
+            }
+
+            return boost::filesystem::path (compiler).filename () == c;
+         }
+
+         bool
+         match (const std::string & line,
+                boost::string_ref & command,
+                std::string & compiler,
+                std::string & filename) const
+         {
+            static const std::regex r ("^([^ ]+) (?:.* )?-c ([^ ]+)(?: .*)?$");
+
+            if ((line.size () < 2) || (line [0] != '['))
+            {
+               return false;
+            }
+
+            const auto i = line.find ("] ");
+            if (i == std::string::npos)
+            {
+               return false;
+            }
+
+            command = boost::string_ref (line).substr (i + 2);
+            return detail::match (r,command,compiler,filename);
+         }
+
+         bool
+         track_directory (const std::string & line,
+                          std::vector<boost::filesystem::path> & directories) const
+         {
+            static const std::vector<std::string> tools = { "ninja" };
+
+            bool entering;
+            boost::filesystem::path directory;
+            if (!detail::entering_directory (line,tools,entering,directory) ||
+                !entering)
+            {
+               return false;
+            }
+
+            directories.resize (1);
+            directories.push_back (detail::join (directories.back (),directory));
+            return true;
+         }
+      };
+
+      // a regular expression given at run time that captures the
+      // compiler and the filename
+      class custom : public default_languages
+      {
+      public:
+         explicit
+         custom (const std::string & compile_command_regex) :
+            regex_ (compile_command_regex)
+         {
+         }
+
+         static const char *
+         name ()
+         {
+            return "custom";
+         }
+
+         bool
+         match (const std::string & line,
+                boost::string_ref & command,
+                std::string & compiler,
+                std::string & filename) const
+         {
+            command = line;
+            return detail::match (regex_,command,compiler,filename);
+         }
+
+         bool
+         track_directory (const std::string &,
+                          std::vector<boost::filesystem::path> &) const
+         {
+            return false;
+         }
+
+      private:
+         std::regex regex_;
+      };
+
+      // adds an entry to the compilation map for each compile command
+      // in the build log
+      template <typename Profile>
+      void
+      parse (std::istream & is,
+             const Profile & profile,
+             const parse_options & options,
+             compilation_map & compilation_map)
+      {
+         std::vector<boost::filesystem::path> directories = { options.root_directory };
+
+         // a build log repeats the commands that are run again, the
+         // cache is only kept while parsing
+         path_normalizer normalizer;
+
+         std::string line;
+         boost::string_ref command;
+         std::string compiler;
+         std::string filename;
+
+         while (std::getline (is,line))
+         {
+            boost::trim (line);
+
+            if (line == "")
+            {
+               continue;
+            }
+
+            if (profile.track_directory (line,directories))
+            {
+               continue;
+            }
+
+            if (!profile.match (line,command,compiler,filename))
+            {
+               continue;
+            }
+
+            // check if the compiler and filename extension are supported
+            const auto e = compilation_database::extension (filename);
+
+            if (std::find_if (std::begin (options.compilers),
+                              std::end (options.compilers),
+                              [&profile,&compiler] (const boost::filesystem::path & c) { return profile.matches_compiler (compiler,c); }) ==
+                std::end (options.compilers))
+            {
+               continue;
+            }
+
+            if (std::find_if (std::begin (options.extensions),
+                              std::end (options.extensions),
+                              [&e] (const boost::filesystem::path & x) { return x.native () == e; }) ==
+                std::end (options.extensions))
+            {
+               continue;
+            }
+
+            const compilation_database_entry entry =
+            {
+               directories.back (),
+               command.to_string (),
+               filename
+            };
+
+            compilation_map.upsert (normalizer (entry.directory.string (),filename),entry);
+         }
+      }
+
+      template <typename Profile>
+      void
+      parse_default (std::istream & is,
+                     const parse_options & options,
+                     compilation_map & compilation_map)
+      {
+         parse (is,Profile (),options,compilation_map);
+      }
+
+      struct registered_profile
+      {
+         void (*parse) (std::istream &,const parse_options &,compilation_map &);
+         std::vector<boost::filesystem::path> compilers;
+         std::vector<boost::filesystem::path> extensions;
+      };
+
+      // the profiles by name, add a profile with
+      //
+      //    r.add<my_build_tool> ();
+      class registry
+      {
+      public:
+         template <typename Profile>
+         void
+         add ()
+         {
+            const registered_profile p =
+            {
+               &parse_default<Profile>,
+               Profile::compilers (),
+               Profile::extensions ()
+            };
+
+            profiles_ [Profile::name ()] = p;
+         }
+
+         // returns nullptr if there is no profile with the name
+         const registered_profile *
+         find (const std::string & name) const;
+
+         std::vector<std::string>
+         names () const;
+
+      private:
+         std::map<std::string,registered_profile> profiles_;
+      };
+
+      // the registry of the profiles above except custom
+      const registry &
+      default_registry ();
+
+   }
+
+}
+
+#endif
@@ -4,15 +4,13 @@
 #include <fstream>
 #include <boost/filesystem.hpp>
 
-#include <algorithm>
 #include <boost/algorithm/string.hpp>
 
-#include <map>
 #include <vector>
 #include <string>
 
-#include <regex>
 #include "compilation_database.hpp"
+#include "build_tools.hpp"
 
 struct arguments_type
 {
@@ -31,66 +29,6 @@ main (int argc, char * argv [])
 {
    auto description = "Generate a Clang compilation database from compiler commands.";
 
-   std::vector<boost::filesystem::path> default_compilers =
-   {
-      "cc",
-      "c++",
-
-      "clang",
-      "clang++",
-
-      "gcc",
-      "g++",
-
-      "cl",
-
-      // for now
-      "/usr/local/bin/clang-3.4",
-      "/usr/local/bin/clang++-3.4"
-   };
-
-   std::vector<boost::filesystem::path> c_extensions =
-   {
-      ".c",
-      ".h"
-   };
-
-   std::vector<boost::filesystem::path> cxx_extensions =
-   {
-      ".cpp",
-      ".hpp",
-      ".cc",
-      ".hh",
-      ".cxx",
-      ".hxx",
-      ".C",
-      ".H"
-   };
-
-   std::vector<boost::filesystem::path> objc_extensions =
-   {
-      ".m"
-   };
-
-   std::vector<boost::filesystem::path> objcxx_extensions =
-   {
-      ".mm"
-   };
-
-   std::vector<boost::filesystem::path> default_extensions;
-   default_extensions.insert (default_extensions.end (),
-                              c_extensions.begin (),
-                              c_extensions.end ());
-   default_extensions.insert (default_extensions.end (),
-                              cxx_extensions.begin (),
-                              cxx_extensions.end ());
-   default_extensions.insert (default_extensions.end (),
-                              objc_extensions.begin (),
-                              objc_extensions.end ());
-   default_extensions.insert (default_extensions.end (),
-                              objcxx_extensions.begin (),
-                              objcxx_extensions.end ());
-
    arguments_type args;
 
    boost::program_options::options_description parser (description);
@@ -107,18 +45,20 @@ main (int argc, char * argv [])
       )
       (
          "compilers",
-         boost::program_options::value<std::vector<boost::filesystem::path>> (&args.compilers)->default_value (default_compilers,""),
+         boost::program_options::value<std::vector<boost::filesystem::path>> (&args.compilers)->composing (),
          "A list of additional compilers."
       )
       (
          "extensions",
-         boost::program_options::value<std::vector<boost::filesystem::path>> (&args.extensions)->composing ()->default_value (default_extensions,""),
+         boost::program_options::value<std::vector<boost::filesystem::path>> (&args.extensions)->composing (),
          "A list of additional filename extensions."
       )
       (
          "build-tool",
          boost::program_options::value<std::string> (&args.build_tool)->default_value (""),
-         "The build tool that generated the input."
+         ("The build tool that generated the input, one of: " +
+          boost::algorithm::join (compilation_database::build_tools::default_registry ().names (),", ") +
+          ".").c_str ()
       )
       (
          "compile-command-regex",
@@ -153,17 +93,15 @@ main (int argc, char * argv [])
    args.output_filename =
       boost::filesystem::absolute (args.output_filename);
 
-   std::regex compile_command_regex;
+   // the custom profile is used if there is a regex
+   const compilation_database::build_tools::registered_profile * profile = nullptr;
    if (args.compile_command_regex == "")
    {
-      if ((args.build_tool == "") ||
-          (args.build_tool == "make"))
-      {
-         compile_command_regex = std::regex ("^([^ ]+) .* ([^ ]+) +-o [^ ]+ *$");
-      }
-      else if (args.build_tool == "Boost.Build")
+      profile = compilation_database::build_tools::default_registry ().find (args.build_tool != "" ? args.build_tool : "make");
+      if (profile == nullptr)
       {
-         compile_command_regex = std::regex ("^\"([^\"]+)\" .+ \"([^\"]+)\"$");
+         std::cout << "error: unknown build tool " << args.build_tool << ".\n";
+         return 1;
       }
    }
    else
@@ -172,109 +110,51 @@ main (int argc, char * argv [])
       {
          std::cout << "warning: regex overriding build tool option\n";
       }
+   }
 
-      compile_command_regex = std::regex (args.compile_command_regex);
+   compilation_database::build_tools::parse_options options;
+   options.root_directory =
+      args.root_directory != "" ? args.root_directory : boost::filesystem::current_path ();
+   options.compilers = args.compilers;
+   options.extensions = args.extensions;
+   if (options.compilers.empty ())
+   {
+      options.compilers = profile != nullptr ? profile->compilers : compilation_database::build_tools::custom::compilers ();
+   }
+   if (options.extensions.empty ())
+   {
+      options.extensions = profile != nullptr ? profile->extensions : compilation_database::build_tools::custom::extensions ();
    }
 
    // create the initial compilation database
-   compilation_database::compilation_database_type compilation_database;
+   compilation_database::compilation_map compilation_map;
    if (args.incremental)
    {
       if (boost::filesystem::exists (args.output_filename))
       {
          std::ifstream ifs (args.output_filename.c_str ());
 
-         compilation_database = compilation_database::load (ifs);
+         compilation_map.load (ifs);
       }
    }
 
-   // generate a more efficient compilation map by filename
-   std::map<std::string,compilation_database::compilation_database_entry> compilation_map;
-   for (const auto & entry : compilation_map)
-   {
-      boost::filesystem::path f (entry.second.filename);
-      if (!f.is_absolute ())
-      {
-         f = entry.second.directory / f;
-      }
-      compilation_map [f.string ()] = entry.second;
-   }
-
    // parse the compilation log and update the compilation database
-   std::string line;
-   std::smatch m;
-
-   while (std::cin)
+   if (profile != nullptr)
    {
-      std::getline (std::cin,line);
-      boost::trim (line);
-
-      if (line == "")
-      {
-         continue;
-      }
-
-      std::regex_match (line,m,compile_command_regex);
-
-      if (!m.ready ())
-      {
-         continue;
-      }
-
-      if (m.size () != 3)
-      {
-         continue;
-      }
-
-      const boost::filesystem::path compiler (m [1]);
-      boost::filesystem::path filename (m [2]);
-
-      // check if the filename extension is supported
-      auto n = filename.parent_path () / filename.stem ();
-      auto e = filename.extension ();
-
-      if (std::find (std::begin (args.compilers),
-                     std::end (args.compilers),
-                     compiler.string ()) ==
-          std::end (args.compilers))
-      {
-         continue;
-      }
-
-      if (std::find (std::begin (args.extensions),
-                     std::end (args.extensions),
-                     e) ==
-          std::end (args.extensions))
-      {
-         continue;
-      }
-
-      const compilation_database::compilation_database_entry entry =
-      {
-         args.root_directory != "" ? args.root_directory : boost::filesystem::current_path (),
-         line,
-         filename
-      };
-
-      auto f = entry.filename;
-      if (!f.is_absolute ())
-      {
-         f = entry.directory / f;
-      }
-
-      compilation_map [f.string ()] = entry;
+      profile->parse (std::cin,options,compilation_map);
    }
-
-   compilation_database.clear ();
-   for (const auto & entry : compilation_map)
+   else
    {
-      compilation_database.push_back(entry.second);
+      compilation_database::build_tools::parse (std::cin,
+                                                compilation_database::build_tools::custom (args.compile_command_regex),
+                                                options,
+                                                compilation_map);
    }
 
    // print as json
    {
       std::ofstream ofs (args.output_filename.c_str ());
-      compilation_database::dump (compilation_database,ofs);
+      compilation_map.dump (ofs);
    }
 
    return 0;
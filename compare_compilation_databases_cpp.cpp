@@ -0,0 +1,353 @@
+#include <boost/program_options.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <boost/algorithm/string.hpp>
+#include <boost/uuid/detail/sha1.hpp>
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <set>
+#include <vector>
+#include <string>
+
+#include "compilation_database.hpp"
+
+struct arguments_type
+{
+   bool help;
+   std::vector<boost::filesystem::path> filenames;
+};
+
+// splits a command into words as a POSIX shell does, so that quoted
+// whitespace is part of a word and a backslash in double quotes is
+// kept unless it escapes $, `, ", \, or a newline
+std::vector<std::string>
+tokenize (const std::string & command)
+{
+   std::vector<std::string> tokens;
+
+   std::string token;
+   bool in_token = false;
+   char quote = '\0';
+
+   for (auto i = std::begin (command); i != std::end (command); ++i)
+   {
+      const char c = *i;
+
+      if (quote == '\'')
+      {
+         if (c == '\'')
+         {
+            quote = '\0';
+         }
+         else
+         {
+            token.push_back (c);
+         }
+      }
+      else if (quote == '"')
+      {
+         // in double quotes a backslash only escapes these characters
+         static const std::string escaped ("$`\"\\\n");
+
+         if ((c == '\\') &&
+             ((i + 1) != std::end (command)) &&
+             (escaped.find (*(i + 1)) != std::string::npos))
+         {
+            ++i;
+            token.push_back (*i);
+         }
+         else if (c == '"')
+         {
+            quote = '\0';
+         }
+         else
+         {
+            token.push_back (c);
+         }
+      }
+      else if ((c == '\\') && ((i + 1) != std::end (command)))
+      {
+         ++i;
+         token.push_back (*i);
+         in_token = true;
+      }
+      else if ((c == '"') || (c == '\''))
+      {
+         quote = c;
+         in_token = true;
+      }
+      else if (std::isspace (static_cast<unsigned char> (c)))
+      {
+         if (in_token)
+         {
+            tokens.push_back (token);
+            token.clear ();
+            in_token = false;
+         }
+      }
+      else
+      {
+         token.push_back (c);
+         in_token = true;
+      }
+   }
+
+   if (in_token)
+   {
+      tokens.push_back (token);
+   }
+
+   return tokens;
+}
+
+std::string
+normalized_directory (const compilation_database::compilation_database_entry & entry)
+{
+   std::string d;
+   compilation_database::normalize ("",entry.directory.string (),d);
+
+   return d;
+}
+
+typedef std::array<unsigned int,5> digest_type;
+
+// a SHA-1 digest of the directory and the tokenized command so that
+// only the digest of each entry of the first database is held in
+// memory, the filename is not part of the digest since it is part of
+// the key
+digest_type
+entry_digest (const compilation_database::compilation_database_entry & entry)
+{
+   boost::uuids::detail::sha1 sha1;
+
+   // each string is preceded by its size so that the words cannot run
+   // together
+   auto process = [&sha1] (const std::string & s)
+   {
+      const auto n = static_cast<std::uint64_t> (s.size ());
+      sha1.process_bytes (&n,sizeof (n));
+      sha1.process_bytes (s.data (),s.size ());
+   };
+
+   process (normalized_directory (entry));
+   for (const auto & t : tokenize (entry.command))
+   {
+      process (t);
+   }
+
+   boost::uuids::detail::sha1::digest_type d;
+   sha1.get_digest (d);
+
+   digest_type digest;
+   std::copy (std::begin (d),std::end (d),std::begin (digest));
+   return digest;
+}
+
+bool
+identical_files (const boost::filesystem::path & f0,
+                 const boost::filesystem::path & f1)
+{
+   if (boost::filesystem::file_size (f0) != boost::filesystem::file_size (f1))
+   {
+      return false;
+   }
+
+   std::ifstream ifs0 (f0.c_str (),std::ios::binary);
+   std::ifstream ifs1 (f1.c_str (),std::ios::binary);
+
+   std::vector<char> buffer0 (64 * 1024);
+   std::vector<char> buffer1 (64 * 1024);
+
+   while (ifs0 && ifs1)
+   {
+      ifs0.read (buffer0.data (),buffer0.size ());
+      ifs1.read (buffer1.data (),buffer1.size ());
+
+      if ((ifs0.gcount () != ifs1.gcount ()) ||
+          !std::equal (buffer0.begin (),
+                       buffer0.begin () + ifs0.gcount (),
+                       buffer1.begin ()))
+      {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+int
+main (int argc, char * argv [])
+{
+   auto description = "Compare two Clang compilation databases.";
+
+   arguments_type args;
+
+   boost::program_options::options_description parser (description);
+   parser.add_options ()
+      (
+         "help,h",
+         boost::program_options::bool_switch (&args.help)->default_value (false),
+         "Print the help."
+      )
+      (
+         "filenames",
+         boost::program_options::value<std::vector<boost::filesystem::path>> (&args.filenames),
+         "The filenames of the files to compare."
+      )
+      ;
+
+   boost::program_options::positional_options_description positional;
+   positional.add ("filenames",2);
+
+   boost::program_options::variables_map vm;
+   boost::program_options::store (boost::program_options::command_line_parser (argc,argv)
+                                  .options (parser)
+                                  .positional (positional)
+                                  .run (),
+                                  vm);
+   boost::program_options::notify (vm);
+
+   if (args.help)
+   {
+      std::cout << parser << "\n";
+      return 1;
+   }
+
+   if (args.filenames.size () != 2)
+   {
+      std::cout << "error: two filenames are required.\n";
+      return 1;
+   }
+
+   const auto & f0 = args.filenames [0];
+   const auto & f1 = args.filenames [1];
+
+   for (const auto & f : args.filenames)
+   {
+      if (!boost::filesystem::exists (f))
+      {
+         std::cout << "error: " << f.string () << " does not exist.\n";
+         return 1;
+      }
+   }
+
+   if (identical_files (f0,f1))
+   {
+      return 0;
+   }
+
+   struct matched_digest_type
+   {
+      digest_type digest;
+      bool matched;
+   };
+
+   // index the first database by key
+   std::unordered_map<std::string,matched_digest_type> digests;
+   {
+      std::ifstream ifs (f0.c_str ());
+      compilation_database::load (ifs,
+                                  [&digests] (const compilation_database::compilation_database_entry & entry)
+                                  {
+                                     digests [compilation_database::key (entry)] = { entry_digest (entry), false };
+                                  });
+   }
+
+   // join the second database against it
+   std::set<std::string> added;
+   std::set<std::string> removed;
+   std::set<std::string> changed;
+   std::unordered_map<std::string,compilation_database::compilation_database_entry> changed_entries;
+   {
+      std::ifstream ifs (f1.c_str ());
+      compilation_database::load (ifs,
+                                  [&] (const compilation_database::compilation_database_entry & entry)
+                                  {
+                                     const auto key = compilation_database::key (entry);
+                                     auto i = digests.find (key);
+                                     if (i == std::end (digests))
+                                     {
+                                        added.insert (key);
+                                        return;
+                                     }
+
+                                     i->second.matched = true;
+                                     if (i->second.digest != entry_digest (entry))
+                                     {
+                                        changed.insert (key);
+                                        changed_entries [key] = entry;
+                                     }
+                                  });
+   }
+
+   for (const auto & d : digests)
+   {
+      if (!d.second.matched)
+      {
+         removed.insert (d.first);
+      }
+   }
+
+   if (added.empty () && removed.empty () && changed.empty ())
+   {
+      return 0;
+   }
+
+   // only the changed entries of the first database are needed for the report
+   std::unordered_map<std::string,compilation_database::compilation_database_entry> original_entries;
+   if (!changed.empty ())
+   {
+      std::ifstream ifs (f0.c_str ());
+      compilation_database::load (ifs,
+                                  [&] (const compilation_database::compilation_database_entry & entry)
+                                  {
+                                     const auto key = compilation_database::key (entry);
+                                     if (changed.count (key) != 0)
+                                     {
+                                        original_entries [key] = entry;
+                                     }
+                                  });
+   }
+
+   for (const auto & k : removed)
+   {
+      std::cout << "removed: " << k << "\n";
+   }
+   for (const auto & k : added)
+   {
+      std::cout << "added: " << k << "\n";
+   }
+   for (const auto & k : changed)
+   {
+      const auto & e0 = original_entries [k];
+      const auto & e1 = changed_entries [k];
+
+      // only print what is different
+      std::cout << "changed: " << k << "\n";
+      if (normalized_directory (e0) != normalized_directory (e1))
+      {
+         std::cout << "  - directory: " << e0.directory.string () << "\n";
+         std::cout << "  + directory: " << e1.directory.string () << "\n";
+      }
+      if (tokenize (e0.command) != tokenize (e1.command))
+      {
+         std::cout << "  - " << e0.command << "\n";
+         std::cout << "  + " << e1.command << "\n";
+      }
+   }
+
+   std::cout <<
+      "error: compilation databases are different: " <<
+      added.size () << " added, " <<
+      removed.size () << " removed, " <<
+      changed.size () << " changed.\n";
+
+   return 1;
+}
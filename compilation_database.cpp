@@ -0,0 +1,657 @@
+#include "compilation_database.hpp"
+
+#include <boost/algorithm/string.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+#include "json.hpp"
+
+namespace compilation_database
+{
+
+   namespace
+   {
+
+      // extracts the value of a trimmed "key": "value"[,] line
+      bool
+      field_value (const std::string & line,
+                   const std::string & key,
+                   std::string & value)
+      {
+         const std::string prefix = "\"" + key + "\": \"";
+         if (!boost::starts_with (line,prefix))
+         {
+            return false;
+         }
+
+         auto last = line.size ();
+         if ((last > 0) && (line [last - 1] == ','))
+         {
+            --last;
+         }
+         if ((last <= prefix.size ()) || (line [last - 1] != '"'))
+         {
+            return false;
+         }
+
+         value = json::unescape (line.substr (prefix.size (),last - 1 - prefix.size ()));
+         return true;
+      }
+
+      // the key of a filename relative to the current directory, which
+      // is only needed if the filename is relative
+      void
+      filename_key (const boost::filesystem::path & filename,
+                    std::string & k)
+      {
+         k.clear ();
+         if (is_absolute (filename.string ()))
+         {
+            normalize ("",filename.string (),k);
+         }
+         else
+         {
+            normalize (boost::filesystem::current_path ().string (),filename.string (),k);
+         }
+      }
+
+      // a read-only memory mapping of a whole file
+      class mapped_file
+      {
+      public:
+         mapped_file ()
+         {
+         }
+
+         explicit
+         mapped_file (const boost::filesystem::path & filename)
+         {
+            // an empty file cannot be mapped
+            if (boost::filesystem::file_size (filename) != 0)
+            {
+               boost::interprocess::file_mapping mapping (filename.c_str (),
+                                                          boost::interprocess::read_only);
+               region_ = boost::interprocess::mapped_region (mapping,
+                                                             boost::interprocess::read_only);
+            }
+         }
+
+         const char *
+         begin () const
+         {
+            return static_cast<const char *> (region_.get_address ());
+         }
+
+         const char *
+         end () const
+         {
+            return begin () + region_.get_size ();
+         }
+
+      private:
+         boost::interprocess::mapped_region region_;
+      };
+
+      const char *
+      find (const char * first,
+            const char * last,
+            const std::string & needle)
+      {
+         if (needle.empty ())
+         {
+            return first;
+         }
+
+         while (static_cast<std::size_t> (last - first) >= needle.size ())
+         {
+            auto p = static_cast<const char *> (std::memchr (first,
+                                                             needle [0],
+                                                             (last - first) - needle.size () + 1));
+            if (p == nullptr)
+            {
+               break;
+            }
+            if (std::memcmp (p,needle.data (),needle.size ()) == 0)
+            {
+               return p;
+            }
+            first = p + 1;
+         }
+
+         return last;
+      }
+
+      const char *
+      line_begin (const char * first,
+                  const char * p)
+      {
+         while ((p != first) && (*(p - 1) != '\n'))
+         {
+            --p;
+         }
+
+         return p;
+      }
+
+      const char *
+      line_end (const char * p,
+                const char * last)
+      {
+         auto e = static_cast<const char *> (std::memchr (p,'\n',last - p));
+
+         return (e != nullptr) ? e : last;
+      }
+
+      std::string
+      trimmed_line (const char * b,
+                    const char * e)
+      {
+         return boost::trim_copy (std::string (b,e));
+      }
+
+      // parses the entry containing the line starting at p
+      bool
+      entry_at (const char * first,
+                const char * last,
+                const char * p,
+                compilation_database_entry & entry)
+      {
+         auto b = p;
+         while (trimmed_line (b,line_end (b,last)) != "{")
+         {
+            if (b == first)
+            {
+               return false;
+            }
+            b = line_begin (first,b - 1);
+         }
+
+         auto e = b;
+         while (e != last)
+         {
+            auto l = line_end (e,last);
+            const bool done = boost::starts_with (trimmed_line (e,l),"}");
+            e = (l != last) ? l + 1 : last;
+            if (done)
+            {
+               break;
+            }
+         }
+
+         std::istringstream iss (std::string (b,e));
+         reader r (iss);
+
+         return r.next (entry);
+      }
+
+      // the offset of the entry for the key in the sorted
+      // "key\toffset" lines of an index
+      enum class index_result
+      {
+         found,
+         missing,
+         malformed
+      };
+
+      index_result
+      index_offset (const char * first,
+                    const char * last,
+                    const std::string & k,
+                    std::size_t & offset)
+      {
+         auto lo = first;
+         auto hi = last;
+         while (lo < hi)
+         {
+            auto mid = line_begin (lo,lo + (hi - lo) / 2);
+            auto l = line_end (mid,last);
+            if (std::string (mid,std::find (mid,l,'\t')) < k)
+            {
+               lo = (l != last) ? l + 1 : l;
+            }
+            else
+            {
+               hi = mid;
+            }
+         }
+
+         auto l = line_end (lo,last);
+         auto t = std::find (lo,l,'\t');
+         if ((lo != last) && (t == l))
+         {
+            return index_result::malformed;
+         }
+         if ((t == l) || (std::string (lo,t) != k))
+         {
+            return index_result::missing;
+         }
+
+         const std::string o (t + 1,l);
+         char * end = nullptr;
+         errno = 0;
+         const auto n = std::strtoull (o.c_str (),&end,10);
+         if (o.empty () || (end != o.c_str () + o.size ()) || (errno != 0))
+         {
+            return index_result::malformed;
+         }
+
+         offset = n;
+         return index_result::found;
+      }
+
+      bool
+      query_scan (const char * first,
+                  const char * last,
+                  const std::string & k,
+                  const std::string & needle,
+                  compilation_database_entry & entry)
+      {
+         const std::string prefix = "\"file\": \"";
+
+         for (auto p = find (first,last,needle); p != last; p = find (p + 1,last,needle))
+         {
+            // the needle must end the value of a "file" field, which
+            // may be followed by another field
+            const auto e = p + needle.size ();
+            if ((p == first) ||
+                ((*(p - 1) != '"') && (*(p - 1) != '/') && (*(p - 1) != '\\')))
+            {
+               continue;
+            }
+            const auto rest = boost::trim_copy (std::string (e,line_end (e,last)));
+            if (!boost::starts_with (trimmed_line (line_begin (first,p),e),prefix) ||
+                (!rest.empty () && (rest != ",")))
+            {
+               continue;
+            }
+
+            compilation_database_entry candidate;
+            if (entry_at (first,last,line_begin (first,p),candidate) &&
+                (key (candidate) == k))
+            {
+               entry = candidate;
+               return true;
+            }
+         }
+
+         return false;
+      }
+
+      // searches for the last component of the key as it is written
+      // by dump and as it is written by Python
+      bool
+      query_scan (const char * first,
+                  const char * last,
+                  const std::string & k,
+                  compilation_database_entry & entry)
+      {
+         const auto name = k.substr (k.find_last_of ('/') + 1);
+
+         const auto needle = json::escape (name) + "\"";
+         if (query_scan (first,last,k,needle,entry))
+         {
+            return true;
+         }
+
+         const auto ascii_needle = json::escape_ascii (name) + "\"";
+         return (ascii_needle != needle) && query_scan (first,last,k,ascii_needle,entry);
+      }
+
+      // the last line of a complete index
+      const std::string index_footer = "# end";
+
+      // the first line of an index identifies the database file that
+      // it was written for
+      std::string
+      index_header (const boost::filesystem::path & database_filename)
+      {
+         std::ostringstream oss;
+         oss <<
+            "# " <<
+            boost::filesystem::file_size (database_filename) << " " <<
+            boost::filesystem::last_write_time (database_filename);
+
+         return oss.str ();
+      }
+
+   }
+
+   std::string
+   key (const compilation_database_entry & entry)
+   {
+      std::string k;
+      normalize (entry.directory.string (),entry.filename.string (),k);
+
+      return k;
+   }
+
+   reader::reader (std::istream & is) :
+      is_ (is)
+   {
+   }
+
+   bool
+   reader::next (compilation_database_entry & entry)
+   {
+      std::string command;
+      std::string directory;
+      std::string filename;
+
+      while (std::getline (is_,line_))
+      {
+         boost::trim (line_);
+
+         if (field_value (line_,"command",command) ||
+             field_value (line_,"directory",directory) ||
+             field_value (line_,"file",filename))
+         {
+            continue;
+         }
+
+         if (boost::starts_with (line_,"}"))
+         {
+            entry.directory = directory;
+            entry.command = command;
+            entry.filename = filename;
+
+            return true;
+         }
+      }
+
+      return false;
+   }
+
+   writer::writer (std::ostream & os) :
+      os_ (os),
+      first_ (true)
+   {
+      os_ << "[\n";
+   }
+
+   void
+   writer::write (const compilation_database_entry & entry)
+   {
+      if (!first_)
+      {
+         os_ << ", " << "\n";
+      }
+      first_ = false;
+
+      // sorted by keys
+      os_ <<
+         "  {" << "\n" <<
+         "    \"command\": \"" << json::escape (entry.command) << "\", " << "\n" <<
+         "    \"directory\": \"" << json::escape (entry.directory.string ()) << "\", " << "\n" <<
+         "    \"file\": \"" << json::escape (entry.filename.string ()) << "\"\n"
+         "  }";
+   }
+
+   void
+   writer::finish ()
+   {
+      if (!first_)
+      {
+         os_ << "\n";
+      }
+      os_ << "]";
+   }
+
+   void
+   compilation_map::upsert (const compilation_database_entry & entry)
+   {
+      // the buffer is reused to avoid an allocation for each entry
+      key_.clear ();
+      normalize (entry.directory.string (),entry.filename.string (),key_);
+
+      map_ [key_] = entry;
+   }
+
+   void
+   compilation_map::upsert (const std::string & key,
+                            const compilation_database_entry & entry)
+   {
+      map_ [key] = entry;
+   }
+
+   const compilation_database_entry *
+   compilation_map::find (const boost::filesystem::path & filename) const
+   {
+      std::string k;
+      filename_key (filename,k);
+
+      auto i = map_.find (k);
+      if (i == std::end (map_))
+      {
+         return nullptr;
+      }
+
+      return &i->second;
+   }
+
+   void
+   compilation_map::load (std::istream & is)
+   {
+      compilation_database::load (is,
+                                  [this] (const compilation_database_entry & entry)
+                                  {
+                                     upsert (entry);
+                                  });
+   }
+
+   void
+   compilation_map::dump (std::ostream & os) const
+   {
+      writer w (os);
+      for (const auto & entry : map_)
+      {
+         w.write (entry.second);
+      }
+      w.finish ();
+   }
+
+   std::size_t
+   compilation_map::size () const
+   {
+      return map_.size ();
+   }
+
+   bool
+   compilation_map::empty () const
+   {
+      return map_.empty ();
+   }
+
+   void
+   compilation_map::clear ()
+   {
+      map_.clear ();
+   }
+
+   compilation_map::const_iterator
+   compilation_map::begin () const
+   {
+      return map_.begin ();
+   }
+
+   compilation_map::const_iterator
+   compilation_map::end () const
+   {
+      return map_.end ();
+   }
+
+   compilation_database_type
+   load (std::istream & is)
+   {
+      compilation_database_type compilation_database;
+
+      load (is,
+            [&compilation_database] (const compilation_database_entry & entry)
+            {
+               compilation_database.push_back (entry);
+            });
+
+      return compilation_database;
+   }
+
+   void
+   dump (const compilation_database_type & compilation_database,
+         std::ostream & os)
+   {
+      writer w (os);
+      for (const auto & entry : compilation_database)
+      {
+         w.write (entry);
+      }
+      w.finish ();
+   }
+
+   boost::filesystem::path
+   index_filename (const boost::filesystem::path & database_filename)
+   {
+      return boost::filesystem::path (database_filename.string () + ".index");
+   }
+
+   void
+   write_index (const boost::filesystem::path & database_filename,
+                const boost::filesystem::path & index_filename)
+   {
+      mapped_file database (database_filename);
+
+      std::vector<std::pair<std::string,std::size_t>> offsets;
+      for (auto b = database.begin (); b != database.end ();)
+      {
+         auto l = line_end (b,database.end ());
+         compilation_database_entry entry;
+         if ((trimmed_line (b,l) == "{") &&
+             entry_at (database.begin (),database.end (),b,entry))
+         {
+            offsets.push_back (std::make_pair (key (entry),b - database.begin ()));
+         }
+         b = (l != database.end ()) ? l + 1 : l;
+      }
+
+      std::sort (std::begin (offsets),std::end (offsets));
+
+      // the index is written to a temporary file that is renamed so
+      // that a query never reads a partially written index
+      const auto temporary_filename =
+         boost::filesystem::unique_path (index_filename.string () + ".%%%%-%%%%.tmp");
+      {
+         std::ofstream ofs (temporary_filename.c_str ());
+         ofs << index_header (database_filename) << "\n";
+         for (const auto & o : offsets)
+         {
+            ofs << o.first << "\t" << o.second << "\n";
+         }
+         ofs << index_footer << "\n";
+      }
+      boost::filesystem::rename (temporary_filename,index_filename);
+   }
+
+   struct database::impl
+   {
+      mapped_file database;
+      mapped_file index;
+
+      // the sorted lines of the index after the header, which are
+      // empty if there is no index for the database file
+      const char * index_first = nullptr;
+      const char * index_last = nullptr;
+
+      // the database file may have been written after the index in
+      // the same second that the index was written for, so the
+      // database is searched if the key is not in the index
+      bool index_ambiguous = false;
+   };
+
+   database::database (const boost::filesystem::path & database_filename,
+                       const boost::filesystem::path & index_filename) :
+      impl_ (new impl ())
+   {
+      impl_->database = mapped_file (database_filename);
+
+      if (!boost::filesystem::exists (index_filename))
+      {
+         return;
+      }
+
+      mapped_file index (index_filename);
+      const auto l = line_end (index.begin (),index.end ());
+      if (std::string (index.begin (),l) != index_header (database_filename))
+      {
+         return;
+      }
+
+      // an index without the footer is not complete
+      const auto footer = index_footer + "\n";
+      if ((static_cast<std::size_t> (index.end () - l) < footer.size () + 1) ||
+          !std::equal (footer.begin (),footer.end (),index.end () - footer.size ()))
+      {
+         return;
+      }
+
+      impl_->index = std::move (index);
+      impl_->index_first = l + 1;
+      impl_->index_last = impl_->index.end () - footer.size ();
+      impl_->index_ambiguous =
+         boost::filesystem::last_write_time (index_filename) <=
+         boost::filesystem::last_write_time (database_filename);
+   }
+
+   database::~database ()
+   {
+   }
+
+   bool
+   database::query (const boost::filesystem::path & filename,
+                    compilation_database_entry & entry) const
+   {
+      std::string k;
+      filename_key (filename,k);
+
+      const auto first = impl_->database.begin ();
+      const auto last = impl_->database.end ();
+
+      if (impl_->index_first != nullptr)
+      {
+         std::size_t offset = 0;
+         const auto result = index_offset (impl_->index_first,impl_->index_last,k,offset);
+         if (result == index_result::found)
+         {
+            // fall back to searching if the offset is not for the entry
+            compilation_database_entry candidate;
+            if ((offset < static_cast<std::size_t> (last - first)) &&
+                entry_at (first,last,first + offset,candidate) &&
+                (key (candidate) == k))
+            {
+               entry = candidate;
+               return true;
+            }
+         }
+         else if ((result == index_result::missing) && !impl_->index_ambiguous)
+         {
+            return false;
+         }
+      }
+
+      return query_scan (first,last,k,entry);
+   }
+
+   bool
+   query (const boost::filesystem::path & database_filename,
+          const boost::filesystem::path & index_filename,
+          const boost::filesystem::path & filename,
+          compilation_database_entry & entry)
+   {
+      return database (database_filename,index_filename).query (filename,entry);
+   }
+
+}
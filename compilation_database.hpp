@@ -4,15 +4,12 @@
 #include <iostream>
 #include <boost/filesystem.hpp>
 
-#include <boost/algorithm/string.hpp>
-#include <regex>
-
+#include <map>
+#include <memory>
 #include <vector>
 #include <string>
 
-#include <cassert>
-
-#include "json.hpp"
+#include "path_normalizer.hpp"
 
 namespace compilation_database
 {
@@ -26,89 +23,159 @@ namespace compilation_database
 
    typedef std::vector<compilation_database_entry> compilation_database_type;
 
-   compilation_database_type
-   load (std::istream & is)
+   // the normalized absolute filename of the entry, which is unique in
+   // a database
+   std::string
+   key (const compilation_database_entry & entry);
+
+   // reads entries one at a time so that the whole database need not
+   // be held in memory
+   class reader
    {
-      compilation_database_type compilation_database;
+   public:
+      explicit
+      reader (std::istream & is);
 
-      std::regex command_field_regex ("^\"command\": \"(.+)\",$");
-      std::regex directory_field_regex ("^\"directory\": \"(.+)\",$");
-      std::regex file_field_regex ("^\"file\": \"(.+)\"$");
+      // returns false when there are no more entries
+      bool
+      next (compilation_database_entry & entry);
 
-      std::string line;
-      std::smatch m;
+   private:
+      std::istream & is_;
+      std::string line_;
+   };
 
-      std::string command;
-      std::string directory;
-      std::string filename;
+   // writes entries one at a time, finish must be called after the
+   // last entry
+   class writer
+   {
+   public:
+      explicit
+      writer (std::ostream & os);
 
-      while (is)
-      {
-         std::getline (is,line);
-         boost::trim (line);
-
-         if ((line == "[") || (line == "]"))
-         {
-            continue;
-         }
-
-         std::getline (is,line); // {
-         std::getline (is,line); //    "command":
-         std::regex_match (line,m,command_field_regex);
-         assert (m.ready ());
-         if (m.ready ())
-         {
-            command = m [1];
-         }
-         std::getline (is,line); //    "directory":
-         std::regex_match (line,m,directory_field_regex);
-         assert (m.ready ());
-         if (m.ready ())
-         {
-            directory = m [1];
-         }
-         std::getline (is,line); //    "file":
-         std::regex_match (line,m,file_field_regex);
-         assert (m.ready ());
-         if (m.ready ())
-         {
-            filename = m [1];
-         }
-         std::getline (is,line); // },?
-
-         compilation_database_entry entry =
-         {
-            boost::filesystem::path (directory),
-            command,
-            boost::filesystem::path (filename)
-         };
-
-         compilation_database.push_back (entry);
-      }
+      void
+      write (const compilation_database_entry & entry);
 
-      return compilation_database;
-   }
+      void
+      finish ();
+
+   private:
+      std::ostream & os_;
+      bool first_;
+   };
+
+   // a database indexed by the key of each entry, which is written in
+   // key order
+   class compilation_map
+   {
+   public:
+      typedef std::map<std::string,compilation_database_entry> map_type;
+      typedef map_type::const_iterator const_iterator;
+
+      // adds the entry or replaces the entry with the same key
+      void
+      upsert (const compilation_database_entry & entry);
+
+      // as above with the key of the entry already computed, such as
+      // by a path_normalizer
+      void
+      upsert (const std::string & key,
+              const compilation_database_entry & entry);
+
+      // returns nullptr if there is no entry for the filename, which
+      // is relative to the current directory if not absolute
+      const compilation_database_entry *
+      find (const boost::filesystem::path & filename) const;
+
+      void
+      load (std::istream & is);
+
+      void
+      dump (std::ostream & os) const;
+
+      std::size_t
+      size () const;
 
+      bool
+      empty () const;
+
+      void
+      clear ();
+
+      const_iterator
+      begin () const;
+
+      const_iterator
+      end () const;
+
+   private:
+      map_type map_;
+      std::string key_;
+   };
+
+   // calls f for each entry as it is read
+   template <typename F>
    void
-   dump (const compilation_database_type & compilation_database,
-         std::ostream & os)
+   load (std::istream & is,
+         F f)
    {
-      os << "[\n";
-      for (auto i = std::begin (compilation_database);
-           i != std::end (compilation_database);
-           ++i)
+      reader r (is);
+
+      compilation_database_entry entry;
+      while (r.next (entry))
       {
-         // sorted by keys
-         os <<
-            "  {" << "\n" <<
-            "    \"command\": \"" << json::escape (i->command) << "\", " << "\n" <<
-            "    \"directory\": \"" << json::escape (i->directory.string ()) << "\", " << "\n" <<
-            "    \"file\": \"" << json::escape (i->filename.string ()) << "\"\n"
-            "  }" << ((i != (std::end (compilation_database) - 1)) ? ", " : "") << "\n";
+         f (entry);
       }
-      os << "]";
    }
 
+   compilation_database_type
+   load (std::istream & is);
+
+   void
+   dump (const compilation_database_type & compilation_database,
+         std::ostream & os);
+
+   // the default filename of the index of a database file
+   boost::filesystem::path
+   index_filename (const boost::filesystem::path & database_filename);
+
+   // writes an index of the byte offset of each entry sorted by key,
+   // which records the size and modification time of the database
+   // file so that it is not used after the database file is written
+   void
+   write_index (const boost::filesystem::path & database_filename,
+                const boost::filesystem::path & index_filename);
+
+   // a database file that is open for queries without loading it,
+   // which must be opened again after the database file is written
+   class database
+   {
+   public:
+      database (const boost::filesystem::path & database_filename,
+                const boost::filesystem::path & index_filename);
+
+      ~database ();
+
+      // finds the entry for the filename, which is relative to the
+      // current directory if not absolute, using the index if it was
+      // written for the database file and otherwise searching the
+      // database file for the filename
+      bool
+      query (const boost::filesystem::path & filename,
+             compilation_database_entry & entry) const;
+
+   private:
+      struct impl;
+      std::unique_ptr<impl> impl_;
+   };
+
+   // opens the database for a single query
+   bool
+   query (const boost::filesystem::path & database_filename,
+          const boost::filesystem::path & index_filename,
+          const boost::filesystem::path & filename,
+          compilation_database_entry & entry);
+
 }
 
 #endif
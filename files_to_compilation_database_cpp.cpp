@@ -11,8 +11,8 @@
 #include <vector>
 #include <string>
 
-#include <regex>
 #include "compilation_database.hpp"
+#include "languages.hpp"
 
 struct arguments_type
 {
@@ -36,61 +36,7 @@ main (int argc, char * argv [])
 {
    auto description = "Generate a Clang compilation database from compiler commands.";
 
-   std::vector<boost::filesystem::path> c_extensions =
-   {
-      ".c"
-   };
-
-   std::vector<boost::filesystem::path> h_extensions =
-   {
-      ".h"
-   };
-
-   std::vector<boost::filesystem::path> cxx_extensions =
-   {
-      ".cpp",
-      ".cc",
-      ".cxx",
-      ".C"
-   };
-
-   std::vector<boost::filesystem::path> hxx_extensions =
-   {
-      ".hpp",
-      ".hh",
-      ".hxx",
-      ".H"
-   };
-
-   std::vector<boost::filesystem::path> objc_extensions =
-   {
-      ".m"
-   };
-
-   std::vector<boost::filesystem::path> objcxx_extensions =
-   {
-      ".mm"
-   };
-
-   std::vector<boost::filesystem::path> default_extensions;
-   default_extensions.insert (default_extensions.end (),
-                              c_extensions.begin (),
-                              c_extensions.end ());
-   default_extensions.insert (default_extensions.end (),
-                              h_extensions.begin (),
-                              h_extensions.end ());
-   default_extensions.insert (default_extensions.end (),
-                              cxx_extensions.begin (),
-                              cxx_extensions.end ());
-   default_extensions.insert (default_extensions.end (),
-                              hxx_extensions.begin (),
-                              hxx_extensions.end ());
-   default_extensions.insert (default_extensions.end (),
-                              objc_extensions.begin (),
-                              objc_extensions.end ());
-   default_extensions.insert (default_extensions.end (),
-                              objcxx_extensions.begin (),
-                              objcxx_extensions.end ());
+   const auto default_extensions = compilation_database::default_extensions ();
 
    arguments_type args;
 
@@ -180,28 +126,30 @@ main (int argc, char * argv [])
       boost::filesystem::absolute (args.output_filename);
 
    // create the initial compilation database
-   compilation_database::compilation_database_type compilation_database;
+   compilation_database::compilation_map compilation_map;
    if (args.incremental)
    {
       if (boost::filesystem::exists (args.output_filename))
       {
          std::ifstream ifs (args.output_filename.c_str ());
 
-         compilation_database = compilation_database::load (ifs);
+         compilation_map.load (ifs);
       }
    }
 
-   // generate a more efficient compilation map by filename
-   std::map<std::string,compilation_database::compilation_database_entry> compilation_map;
-   for (const auto & entry : compilation_map)
+   // the flags by language name
+   std::map<std::string,std::string> language_flags =
    {
-      boost::filesystem::path f (entry.second.filename);
-      if (!f.is_absolute ())
-      {
-         f = entry.second.directory / f;
-      }
-      compilation_map [f.string ()] = entry.second;
-   }
+      { "c", args.cflags },
+      { "c-header", args.cflags },
+      { "c++", args.cxxflags },
+      { "c++-header", args.cxxflags },
+      { "objective-c", args.objcflags },
+      { "objective-c++", args.objcxxflags }
+   };
+
+   const boost::filesystem::path directory =
+      args.root_directory != "" ? args.root_directory : boost::filesystem::current_path ();
 
    // parse the compilation log and update the compilation database
    std::string line;
@@ -216,72 +164,37 @@ main (int argc, char * argv [])
          continue;
       }
 
-      const boost::filesystem::path compiler ("clang++");
+      const std::string compiler ("clang++");
       std::vector<std::string> flags = { "-c" };
-      boost::filesystem::path filename (line);
+      const auto & filename = line;
 
       // check if the filename extension is supported
-      auto n = filename.parent_path () / filename.stem ();
-      auto e = filename.extension ();
+      const auto e = compilation_database::extension (filename);
+      const auto n = filename.substr (0,filename.size () - e.size ());
+
+      auto has_extension = [&e] (const std::vector<boost::filesystem::path> & extensions)
+      {
+         return std::find_if (std::begin (extensions),
+                              std::end (extensions),
+                              [&e] (const boost::filesystem::path & x) { return x.native () == e; }) !=
+            std::end (extensions);
+      };
 
-      if (std::find (std::begin (args.extensions),
-                     std::end (args.extensions),
-                     e) ==
-          std::end (args.extensions))
+      if (!has_extension (args.extensions))
       {
          continue;
       }
 
-      flags.push_back ("-o " + n.native () + ".o");
+      flags.push_back ("-o " + n + ".o");
 
       flags.push_back (args.flags);
-      if (std::find (std::begin (c_extensions),
-                     std::end (c_extensions),
-                     e) !=
-          std::end (c_extensions))
-      {
-         flags.push_back ("-x c");
-         flags.push_back (args.cflags);
-      }
-      if (std::find (std::begin (h_extensions),
-                     std::end (h_extensions),
-                     e) !=
-          std::end (h_extensions))
-      {
-         flags.push_back ("-x c-header");
-         flags.push_back (args.cflags);
-      }
-      if (std::find (std::begin (cxx_extensions),
-                     std::end (cxx_extensions),
-                     e) !=
-          std::end (cxx_extensions))
-      {
-         flags.push_back ("-x c++");
-         flags.push_back (args.cxxflags);
-      }
-      if (std::find (std::begin (hxx_extensions),
-                     std::end (hxx_extensions),
-                     e) !=
-          std::end (hxx_extensions))
+      for (const auto & l : compilation_database::languages ())
       {
-         flags.push_back ("-x c++-header");
-         flags.push_back (args.cxxflags);
-      }
-      if (std::find (std::begin (objc_extensions),
-                     std::end (objc_extensions),
-                     e) !=
-          std::end (objc_extensions))
-      {
-         flags.push_back ("-x objective-c");
-         flags.push_back (args.objcflags);
-      }
-      if (std::find (std::begin (objcxx_extensions),
-                     std::end (objcxx_extensions),
-                     e) !=
-          std::end (objcxx_extensions))
-      {
-         flags.push_back ("-x objective-c++");
-         flags.push_back (args.objcxxflags);
+         if (has_extension (l.extensions))
+         {
+            flags.push_back ("-x " + l.name);
+            flags.push_back (language_flags [l.name]);
+         }
       }
 
       for (const auto & s : args.includes)
@@ -297,39 +210,27 @@ main (int argc, char * argv [])
          flags.push_back ("-U" + s);
       }
 
-      std::string command = compiler.native ();
+      std::string command = compiler;
       for (const auto & s : flags)
       {
          command += " " + s;
       }
-      command += " " + filename.native ();
+      command += " " + filename;
 
       const compilation_database::compilation_database_entry entry =
       {
-         args.root_directory != "" ? args.root_directory : boost::filesystem::current_path (),
+         directory,
          command,
          filename
       };
 
-      auto f = entry.filename;
-      if (!f.is_absolute ())
-      {
-         f = entry.directory / f;
-      }
-
-      compilation_map [f.string ()] = entry;
-   }
-
-   compilation_database.clear ();
-   for (const auto & entry : compilation_map)
-   {
-      compilation_database.push_back(entry.second);
+      compilation_map.upsert (entry);
    }
 
    // print as json
    {
       std::ofstream ofs (args.output_filename.c_str ());
-      compilation_database::dump (compilation_database,ofs);
+      compilation_map.dump (ofs);
    }
 
    return 0;
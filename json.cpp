@@ -0,0 +1,221 @@
+#include "json.hpp"
+
+namespace json
+{
+
+   std::string
+   escape (const std::string & s)
+   {
+      std::string es;
+      es.reserve (2 * s.size ());
+
+      for (const auto & e : s)
+      {
+         if ((e == '"') || (e == '\\'))
+         {
+            es.push_back ('\\');
+            es.push_back (e);
+         }
+         else
+         {
+            es.push_back (e);
+         }
+      }
+
+      return es;
+   }
+
+   namespace
+   {
+
+      void
+      append_utf8 (unsigned long c,
+                   std::string & s)
+      {
+         if (c < 0x80)
+         {
+            s.push_back (static_cast<char> (c));
+         }
+         else if (c < 0x800)
+         {
+            s.push_back (static_cast<char> (0xc0 | (c >> 6)));
+            s.push_back (static_cast<char> (0x80 | (c & 0x3f)));
+         }
+         else if (c < 0x10000)
+         {
+            s.push_back (static_cast<char> (0xe0 | (c >> 12)));
+            s.push_back (static_cast<char> (0x80 | ((c >> 6) & 0x3f)));
+            s.push_back (static_cast<char> (0x80 | (c & 0x3f)));
+         }
+         else
+         {
+            s.push_back (static_cast<char> (0xf0 | (c >> 18)));
+            s.push_back (static_cast<char> (0x80 | ((c >> 12) & 0x3f)));
+            s.push_back (static_cast<char> (0x80 | ((c >> 6) & 0x3f)));
+            s.push_back (static_cast<char> (0x80 | (c & 0x3f)));
+         }
+      }
+
+      void
+      append_u (unsigned long c,
+                std::string & es)
+      {
+         static const char digits [] = "0123456789abcdef";
+
+         es.append ("\\u");
+         for (int shift = 12; shift >= 0; shift -= 4)
+         {
+            es.push_back (digits [(c >> shift) & 0xf]);
+         }
+      }
+
+      // reads the four hex digits of a \u escape starting at i
+      bool
+      hex4 (std::string::const_iterator i,
+            std::string::const_iterator last,
+            unsigned long & c)
+      {
+         if (last - i < 4)
+         {
+            return false;
+         }
+
+         c = 0;
+         for (auto e = i + 4; i != e; ++i)
+         {
+            c <<= 4;
+            if ((*i >= '0') && (*i <= '9'))
+            {
+               c |= *i - '0';
+            }
+            else if ((*i >= 'a') && (*i <= 'f'))
+            {
+               c |= *i - 'a' + 10;
+            }
+            else if ((*i >= 'A') && (*i <= 'F'))
+            {
+               c |= *i - 'A' + 10;
+            }
+            else
+            {
+               return false;
+            }
+         }
+
+         return true;
+      }
+
+   }
+
+   std::string
+   escape_ascii (const std::string & s)
+   {
+      const auto es = escape (s);
+
+      std::string as;
+      as.reserve (es.size ());
+
+      for (auto i = std::begin (es); i != std::end (es);)
+      {
+         const auto b = static_cast<unsigned char> (*i);
+
+         // the number of continuation bytes
+         int n = 0;
+         unsigned long c = b;
+         if ((b & 0xe0) == 0xc0)
+         {
+            n = 1;
+            c = b & 0x1f;
+         }
+         else if ((b & 0xf0) == 0xe0)
+         {
+            n = 2;
+            c = b & 0x0f;
+         }
+         else if ((b & 0xf8) == 0xf0)
+         {
+            n = 3;
+            c = b & 0x07;
+         }
+
+         if ((n == 0) || (std::end (es) - i <= n))
+         {
+            as.push_back (*i);
+            ++i;
+            continue;
+         }
+
+         ++i;
+         for (int j = 0; j != n; ++i, ++j)
+         {
+            c = (c << 6) | (static_cast<unsigned char> (*i) & 0x3f);
+         }
+
+         if (c >= 0x10000)
+         {
+            c -= 0x10000;
+            append_u (0xd800 + (c >> 10),as);
+            append_u (0xdc00 + (c & 0x3ff),as);
+         }
+         else
+         {
+            append_u (c,as);
+         }
+      }
+
+      return as;
+   }
+
+   std::string
+   unescape (const std::string & es)
+   {
+      std::string s;
+      s.reserve (es.size ());
+
+      for (auto i = std::begin (es); i != std::end (es); ++i)
+      {
+         if ((*i == '\\') && ((i + 1) != std::end (es)))
+         {
+            ++i;
+            unsigned long c;
+            switch (*i)
+            {
+            case 'b': s.push_back ('\b'); break;
+            case 'f': s.push_back ('\f'); break;
+            case 'n': s.push_back ('\n'); break;
+            case 't': s.push_back ('\t'); break;
+            case 'r': s.push_back ('\r'); break;
+            case 'u':
+               if (!hex4 (i + 1,std::end (es),c))
+               {
+                  s.push_back (*i);
+                  break;
+               }
+               i += 4;
+
+               // a high surrogate followed by a low surrogate
+               if ((c >= 0xd800) && (c < 0xdc00) &&
+                   (std::end (es) - i > 2) && (*(i + 1) == '\\') && (*(i + 2) == 'u'))
+               {
+                  unsigned long l;
+                  if (hex4 (i + 3,std::end (es),l) && (l >= 0xdc00) && (l < 0xe000))
+                  {
+                     c = 0x10000 + ((c - 0xd800) << 10) + (l - 0xdc00);
+                     i += 6;
+                  }
+               }
+               append_utf8 (c,s);
+               break;
+            default: s.push_back (*i); break;
+            }
+         }
+         else
+         {
+            s.push_back (*i);
+         }
+      }
+
+      return s;
+   }
+
+}
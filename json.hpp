@@ -7,26 +7,15 @@ namespace json
 {
 
    std::string
-   escape (const std::string & s)
-   {
-      std::string es;
-      es.reserve (2 * s.size ());
+   escape (const std::string & s);
 
-      for (const auto & e : s)
-      {
-         if (e == '"')
-         {
-            es.push_back ('\\');
-            es.push_back ('"');
-         }
-         else
-         {
-            es.push_back (e);
-         }
-      }
+   // escapes as escape does and writes each non-ASCII UTF-8 character
+   // as a \u escape as Python does by default
+   std::string
+   escape_ascii (const std::string & s);
 
-      return es;
-   }
+   std::string
+   unescape (const std::string & es);
 
 }
 
@@ -0,0 +1,78 @@
+#include "languages.hpp"
+
+namespace compilation_database
+{
+
+   const std::vector<language> &
+   languages ()
+   {
+      static const std::vector<language> l =
+      {
+         {
+            "c",
+            { ".c" }
+         },
+         {
+            "c-header",
+            { ".h" }
+         },
+         {
+            "c++",
+            { ".cpp", ".cc", ".cxx", ".C" }
+         },
+         {
+            "c++-header",
+            { ".hpp", ".hh", ".hxx", ".H" }
+         },
+         {
+            "objective-c",
+            { ".m" }
+         },
+         {
+            "objective-c++",
+            { ".mm" }
+         }
+      };
+
+      return l;
+   }
+
+   const std::vector<boost::filesystem::path> &
+   default_compilers ()
+   {
+      static const std::vector<boost::filesystem::path> c =
+      {
+         "cc",
+         "c++",
+
+         "clang",
+         "clang++",
+
+         "gcc",
+         "g++",
+
+         "cl",
+
+         // for now
+         "/usr/local/bin/clang-3.4",
+         "/usr/local/bin/clang++-3.4"
+      };
+
+      return c;
+   }
+
+   std::vector<boost::filesystem::path>
+   default_extensions ()
+   {
+      std::vector<boost::filesystem::path> extensions;
+      for (const auto & l : languages ())
+      {
+         extensions.insert (extensions.end (),
+                            l.extensions.begin (),
+                            l.extensions.end ());
+      }
+
+      return extensions;
+   }
+
+}
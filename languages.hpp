@@ -0,0 +1,31 @@
+#ifndef languages_hpp_
+#define languages_hpp_
+
+#include <boost/filesystem.hpp>
+
+#include <vector>
+#include <string>
+
+namespace compilation_database
+{
+
+   struct language
+   {
+      // the name given to the -x option of the compiler
+      std::string name;
+      std::vector<boost::filesystem::path> extensions;
+   };
+
+   const std::vector<language> &
+   languages ();
+
+   const std::vector<boost::filesystem::path> &
+   default_compilers ();
+
+   // the extensions of all languages
+   std::vector<boost::filesystem::path>
+   default_extensions ();
+
+}
+
+#endif
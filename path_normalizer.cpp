@@ -0,0 +1,196 @@
+#include "path_normalizer.hpp"
+
+#include <algorithm>
+
+namespace compilation_database
+{
+
+   namespace
+   {
+
+      bool
+      has_drive_root (boost::string_ref filename)
+      {
+         return (filename.size () >= 3) && (filename [1] == ':') &&
+            ((filename [2] == '/') || (filename [2] == '\\'));
+      }
+
+      // a backslash is a separator in a Windows filename but is part
+      // of the name on POSIX, where "a\b.cpp" and "a/b.cpp" are
+      // different files
+      bool
+      backslash_separates (boost::string_ref filename)
+      {
+#if defined (_WIN32)
+         (void) filename;
+         return true;
+#else
+         return has_drive_root (filename);
+#endif
+      }
+
+      bool
+      is_separator (char c, bool backslash)
+      {
+         return (c == '/') || (backslash && (c == '\\'));
+      }
+
+      // the length of the root of an absolute filename, "/" or "C:/"
+      std::size_t
+      root_size (boost::string_ref filename, bool backslash)
+      {
+         if (!filename.empty () && is_separator (filename [0],backslash))
+         {
+            return 1;
+         }
+         if (has_drive_root (filename))
+         {
+            return 3;
+         }
+
+         return 0;
+      }
+
+      void
+      append_components (boost::string_ref filename,
+                         std::size_t root,
+                         bool rooted,
+                         bool backslash,
+                         std::string & result)
+      {
+         std::size_t i = 0;
+         while (i != filename.size ())
+         {
+            auto j = i;
+            while ((j != filename.size ()) && !is_separator (filename [j],backslash))
+            {
+               ++j;
+            }
+
+            const auto component = filename.substr (i,j - i);
+            i = (j != filename.size ()) ? j + 1 : j;
+
+            if (component.empty () || (component == "."))
+            {
+               continue;
+            }
+
+            if (component == "..")
+            {
+               const auto k = result.find_last_of ('/');
+               const auto last = ((k == std::string::npos) || (k < root)) ? root : k + 1;
+               if ((result.size () > root) && (result.compare (last,std::string::npos,"..") != 0))
+               {
+                  result.erase ((last > root) ? last - 1 : root);
+                  continue;
+               }
+
+               // ".." at the root is the root
+               if (rooted)
+               {
+                  continue;
+               }
+            }
+
+            if (result.size () > root)
+            {
+               result.push_back ('/');
+            }
+            result.append (component.data (),component.size ());
+         }
+      }
+
+   }
+
+   bool
+   is_absolute (boost::string_ref filename)
+   {
+      return root_size (filename,backslash_separates (filename)) != 0;
+   }
+
+   boost::string_ref
+   extension (boost::string_ref filename)
+   {
+      const bool backslash = backslash_separates (filename);
+
+      auto i = filename.size ();
+      while ((i != 0) && !is_separator (filename [i - 1],backslash))
+      {
+         --i;
+      }
+
+      const auto name = filename.substr (i);
+      if ((name == ".") || (name == ".."))
+      {
+         return boost::string_ref ();
+      }
+
+      const auto dot = name.rfind ('.');
+      if (dot == boost::string_ref::npos)
+      {
+         return boost::string_ref ();
+      }
+
+      return name.substr (dot);
+   }
+
+   void
+   normalize (boost::string_ref directory,
+              boost::string_ref filename,
+              std::string & result)
+   {
+      const auto base = result.size ();
+
+      const auto & first = is_absolute (filename) ? filename : directory;
+
+      // a relative filename is split as its directory is
+      const bool backslash = backslash_separates (first);
+
+      const auto root = base + root_size (first,backslash);
+      result.append (first.data (),root - base);
+      if (backslash)
+      {
+         std::replace (result.begin () + base,result.end (),'\\','/');
+      }
+
+      const bool rooted = root != base;
+
+      if (!is_absolute (filename))
+      {
+         append_components (directory.substr (root - base),root,rooted,backslash,result);
+      }
+      append_components (filename.substr (is_absolute (filename) ? root - base : 0),root,rooted,backslash,result);
+   }
+
+   const std::string &
+   path_normalizer::operator() (boost::string_ref directory,
+                                boost::string_ref filename)
+   {
+      // the directory is not part of the key of an absolute filename
+      key_.clear ();
+      if (!is_absolute (filename))
+      {
+         key_.append (directory.data (),directory.size ());
+      }
+      key_.push_back ('\0');
+      key_.append (filename.data (),filename.size ());
+
+      auto i = cache_.find (key_);
+      if (i != std::end (cache_))
+      {
+         return i->second;
+      }
+
+      std::string result;
+      normalize (directory,filename,result);
+
+      return cache_.emplace (key_,std::move (result)).first->second;
+   }
+
+   void
+   path_normalizer::clear ()
+   {
+      cache_.clear ();
+   }
+
+}
@@ -0,0 +1,51 @@
+#ifndef path_normalizer_hpp_
+#define path_normalizer_hpp_
+
+#include <boost/utility/string_ref.hpp>
+
+#include <unordered_map>
+#include <string>
+
+namespace compilation_database
+{
+
+   bool
+   is_absolute (boost::string_ref filename);
+
+   // the extension of the last component of the filename including
+   // the dot, which is empty if there is none
+   boost::string_ref
+   extension (boost::string_ref filename);
+
+   // appends the filename relative to the directory to result with "."
+   // and ".." components and repeated separators removed, which is
+   // only done lexically and so does not resolve symbolic links, a
+   // backslash is a separator only in a filename with a drive root or
+   // on Windows
+   void
+   normalize (boost::string_ref directory,
+              boost::string_ref filename,
+              std::string & result);
+
+   // normalizes filenames relative to directories, remembering each
+   // result so that the same filename from the same directory is only
+   // normalized once
+   class path_normalizer
+   {
+   public:
+      // the returned reference is valid until clear is called
+      const std::string &
+      operator() (boost::string_ref directory,
+                  boost::string_ref filename);
+
+      void
+      clear ();
+
+   private:
+      std::string key_;
+      std::unordered_map<std::string,std::string> cache_;
+   };
+
+}
+
+#endif
@@ -0,0 +1,116 @@
+#include <boost/program_options.hpp>
+
+#include <iostream>
+#include <boost/filesystem.hpp>
+
+#include <vector>
+#include <string>
+
+#include "compilation_database.hpp"
+
+struct arguments_type
+{
+   bool help;
+   boost::filesystem::path database_filename;
+   boost::filesystem::path index_filename;
+   bool build_index;
+   std::vector<boost::filesystem::path> filenames;
+};
+
+int
+main (int argc, char * argv [])
+{
+   auto description = "Print the entries of a Clang compilation database for the given files.";
+
+   arguments_type args;
+
+   boost::program_options::options_description parser (description);
+   parser.add_options ()
+      (
+         "help,h",
+         boost::program_options::bool_switch (&args.help)->default_value (false),
+         "Print the help."
+      )
+      (
+         "database-filename,d",
+         boost::program_options::value<boost::filesystem::path> (&args.database_filename)->default_value ("compile_commands.json"),
+         "The filename of the compilation database."
+      )
+      (
+         "index-filename",
+         boost::program_options::value<boost::filesystem::path> (&args.index_filename)->default_value (""),
+         "The filename of the index of the compilation database."
+      )
+      (
+         "build-index",
+         boost::program_options::bool_switch (&args.build_index)->default_value (false),
+         "Write the index of the compilation database."
+      )
+      (
+         "filenames",
+         boost::program_options::value<std::vector<boost::filesystem::path>> (&args.filenames)->composing (),
+         "The filenames to print the entries for."
+      )
+      ;
+
+   boost::program_options::positional_options_description positional;
+   positional.add ("filenames",-1);
+
+   boost::program_options::variables_map vm;
+   boost::program_options::store (boost::program_options::command_line_parser (argc,argv)
+                                  .options (parser)
+                                  .positional (positional)
+                                  .run (),
+                                  vm);
+   boost::program_options::notify (vm);
+
+   if (args.help)
+   {
+      std::cout << parser << "\n";
+      return 1;
+   }
+
+   if (!boost::filesystem::exists (args.database_filename))
+   {
+      std::cerr << "error: " << args.database_filename.string () << " does not exist.\n";
+      return 1;
+   }
+
+   if (args.index_filename == "")
+   {
+      args.index_filename = compilation_database::index_filename (args.database_filename);
+   }
+
+   if (args.build_index)
+   {
+      compilation_database::write_index (args.database_filename,args.index_filename);
+   }
+
+   if (args.filenames.empty ())
+   {
+      return 0;
+   }
+
+   const compilation_database::database database (args.database_filename,args.index_filename);
+
+   int status = 0;
+
+   // print as json
+   compilation_database::writer w (std::cout);
+   for (const auto & f : args.filenames)
+   {
+      compilation_database::compilation_database_entry entry;
+      if (database.query (f,entry))
+      {
+         w.write (entry);
+      }
+      else
+      {
+         std::cerr << "error: no entry for " << f.string () << ".\n";
+         status = 1;
+      }
+   }
+   w.finish ();
+
+   return status;
+}